@@ -0,0 +1,395 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "analyzer.h"
+#include "parallel.h"
+
+#define CELLS (BOARD_ROWS * BOARD_COLS)
+
+/* Seeds each worker analyzes per round; the main thread writes a round's
+   output in seed order while nothing else runs */
+#define ANALYZE_CHUNK 16384
+#define ANALYZE_ROW_LENGTH 64
+#define ANALYZE_MAX_THREADS 64
+
+typedef struct {
+    int mine[CELLS];
+    int adjacent[CELLS];
+    int state[CELLS];
+    int hidden[CELLS];  /* hidden neighbours */
+    int flagged[CELLS]; /* flagged neighbours */
+    int queue[CELLS];   /* open numbers whose neighbourhood changed */
+    int queued[CELLS];
+    int queueLength;
+    int stack[CELLS];
+    int safeCells;
+    int openCells;
+} Solver;
+
+typedef struct {
+    unsigned int firstSeed;
+    unsigned int count;
+    char* buffer;
+    size_t length;
+} AnalyzeChunk;
+
+/* The board size is fixed, so the neighbours of every cell are worked out
+   once and shared by all threads. analyzeSeeds builds the table before its
+   workers start; after that every call only reads the ready flag. */
+static int neighbours[CELLS][8];
+static int neighbourCount[CELLS];
+static SDL_SpinLock neighboursLock;
+static SDL_atomic_t neighboursReady;
+
+static void buildNeighbours(void) {
+    if (SDL_AtomicGet(&neighboursReady)) {
+        return;
+    }
+
+    SDL_AtomicLock(&neighboursLock);
+    if (!SDL_AtomicGet(&neighboursReady)) {
+        for (int y = 0; y < BOARD_ROWS; y++) {
+            for (int x = 0; x < BOARD_COLS; x++) {
+                int cell = y * BOARD_COLS + x;
+                neighbourCount[cell] = 0;
+                for (int ny = y - 1; ny <= y + 1; ny++) {
+                    for (int nx = x - 1; nx <= x + 1; nx++) {
+                        if ((ny != y || nx != x) && ny >= 0 && ny < BOARD_ROWS && nx >= 0 && nx < BOARD_COLS) {
+                            neighbours[cell][neighbourCount[cell]++] = ny * BOARD_COLS + nx;
+                        }
+                    }
+                }
+            }
+        }
+        SDL_AtomicSet(&neighboursReady, 1);
+    }
+    SDL_AtomicUnlock(&neighboursLock);
+}
+
+static int findRoot(int parent[], int cell) {
+    while (parent[cell] != cell) {
+        parent[cell] = parent[parent[cell]];
+        cell = parent[cell];
+    }
+    return cell;
+}
+
+static void unite(int parent[], int a, int b) {
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a != b) {
+        parent[a < b ? b : a] = a < b ? a : b;
+    }
+}
+
+static void solverQueue(Solver* solver, int cell) {
+    if (!solver->queued[cell] && solver->adjacent[cell] != 0) {
+        solver->queued[cell] = 1;
+        solver->queue[solver->queueLength++] = cell;
+    }
+}
+
+/* Moves a hidden cell to `state` and lets its open neighbours know */
+static void solverReveal(Solver* solver, int cell, int state) {
+    solver->state[cell] = state;
+    for (int i = 0; i < neighbourCount[cell]; i++) {
+        int next = neighbours[cell][i];
+        solver->hidden[next]--;
+        if (state == CELL_FLAGGED) {
+            solver->flagged[next]++;
+        }
+        if (solver->state[next] == CELL_OPEN) {
+            solverQueue(solver, next);
+        }
+    }
+    if (state == CELL_OPEN) {
+        solver->openCells++;
+        solverQueue(solver, cell);
+    }
+}
+
+/* Same as floodFill, but on the solver's view of the board and without
+   recursion */
+static void solverOpen(Solver* solver, int cell) {
+    int top = 0;
+
+    if (solver->state[cell] != CELL_HIDDEN) {
+        return;
+    }
+    solverReveal(solver, cell, CELL_OPEN);
+    solver->stack[top++] = cell;
+
+    while (top > 0) {
+        cell = solver->stack[--top];
+        if (solver->adjacent[cell] != 0) {
+            continue;
+        }
+        for (int i = 0; i < neighbourCount[cell]; i++) {
+            int next = neighbours[cell][i];
+            if (solver->state[next] == CELL_HIDDEN) {
+                solverReveal(solver, next, CELL_OPEN);
+                solver->stack[top++] = next;
+            }
+        }
+    }
+}
+
+/* Applies the single-cell rules until no queued number can tell more */
+static void solverDeduce(Solver* solver) {
+    while (solver->queueLength > 0) {
+        int cell = solver->queue[--solver->queueLength];
+        solver->queued[cell] = 0;
+
+        int hidden = solver->hidden[cell];
+        int flagged = solver->flagged[cell];
+        if (hidden == 0) {
+            continue;
+        }
+        if (flagged != solver->adjacent[cell] && flagged + hidden != solver->adjacent[cell]) {
+            continue;
+        }
+
+        int safe = flagged == solver->adjacent[cell];
+        for (int i = 0; i < neighbourCount[cell]; i++) {
+            int next = neighbours[cell][i];
+            if (solver->state[next] == CELL_HIDDEN) {
+                if (safe) {
+                    solverOpen(solver, next);
+                } else {
+                    solverReveal(solver, next, CELL_FLAGGED);
+                }
+            }
+        }
+    }
+}
+
+/* Safe cell to click when stuck: an unopened opening if one is left, since
+   that is what a player would hope for, else any safe cell */
+static int solverPick(const Solver* solver) {
+    int fallback = -1;
+
+    for (int cell = 0; cell < CELLS; cell++) {
+        if (solver->state[cell] == CELL_HIDDEN && !solver->mine[cell]) {
+            if (solver->adjacent[cell] == 0) {
+                return cell;
+            }
+            if (fallback < 0) {
+                fallback = cell;
+            }
+        }
+    }
+    return fallback;
+}
+
+static int countGuesses(Solver* solver, int start) {
+    int guesses = 0;
+
+    solverOpen(solver, start);
+    solverDeduce(solver);
+    while (solver->openCells < solver->safeCells) {
+        solverOpen(solver, solverPick(solver));
+        solverDeduce(solver);
+        guesses++;
+    }
+    return guesses;
+}
+
+void analyzeBoard(int mineLocations[][BOARD_COLS], BoardMetrics* metrics) {
+    Solver solver;
+    int parent[CELLS];
+    int openingSize[CELLS];
+
+    buildNeighbours();
+    memset(metrics, 0, sizeof(*metrics));
+    solver.queueLength = 0;
+    solver.safeCells = 0;
+    solver.openCells = 0;
+
+    for (int y = 0; y < BOARD_ROWS; y++) {
+        for (int x = 0; x < BOARD_COLS; x++) {
+            int cell = y * BOARD_COLS + x;
+            solver.mine[cell] = mineLocations[y][x];
+            solver.adjacent[cell] = 0;
+            solver.state[cell] = CELL_HIDDEN;
+            solver.hidden[cell] = neighbourCount[cell];
+            solver.flagged[cell] = 0;
+            solver.queued[cell] = 0;
+            solver.safeCells += !mineLocations[y][x];
+            parent[cell] = cell;
+            openingSize[cell] = 0;
+        }
+    }
+
+    /* Cheaper than countAdjacentMines for every cell: there are far fewer
+       mines than cells */
+    for (int cell = 0; cell < CELLS; cell++) {
+        if (solver.mine[cell]) {
+            for (int i = 0; i < neighbourCount[cell]; i++) {
+                solver.adjacent[neighbours[cell][i]]++;
+            }
+        }
+    }
+
+    /* Joining each zero to the zeros left of, above-left, above and
+       above-right of it covers every 8-neighbour pair exactly once */
+    for (int y = 0; y < BOARD_ROWS; y++) {
+        for (int x = 0; x < BOARD_COLS; x++) {
+            int cell = y * BOARD_COLS + x;
+            if (solver.mine[cell] || solver.adjacent[cell] != 0) {
+                continue;
+            }
+            static const int dy[4] = { 0, -1, -1, -1 };
+            static const int dx[4] = { -1, -1, 0, 1 };
+            for (int i = 0; i < 4; i++) {
+                int ny = y + dy[i];
+                int nx = x + dx[i];
+                int next = ny * BOARD_COLS + nx;
+                if (ny >= 0 && nx >= 0 && nx < BOARD_COLS &&
+                    !solver.mine[next] && solver.adjacent[next] == 0) {
+                    unite(parent, cell, next);
+                }
+            }
+        }
+    }
+
+    /* Zeros count towards their own opening; a number counts towards every
+       opening it borders, or is isolated if it borders none */
+    for (int y = 0; y < BOARD_ROWS; y++) {
+        for (int x = 0; x < BOARD_COLS; x++) {
+            int cell = y * BOARD_COLS + x;
+            if (solver.mine[cell]) {
+                continue;
+            }
+            if (solver.adjacent[cell] == 0) {
+                int root = findRoot(parent, cell);
+                if (root == cell) {
+                    metrics->openings++;
+                }
+                openingSize[root]++;
+                metrics->openedCells++;
+                continue;
+            }
+
+            int roots[8];
+            int rootCount = 0;
+            for (int i = 0; i < neighbourCount[cell]; i++) {
+                int next = neighbours[cell][i];
+                if (solver.mine[next] || solver.adjacent[next] != 0) {
+                    continue;
+                }
+                int root = findRoot(parent, next);
+                int seen = 0;
+                for (int j = 0; j < rootCount; j++) {
+                    seen |= roots[j] == root;
+                }
+                if (!seen) {
+                    roots[rootCount++] = root;
+                    openingSize[root]++;
+                }
+            }
+
+            if (rootCount == 0) {
+                metrics->isolatedNumbers++;
+            } else {
+                metrics->openedCells++;
+            }
+        }
+    }
+
+    metrics->bbbv = metrics->openings + metrics->isolatedNumbers;
+
+    int largestRoot = -1;
+    for (int cell = 0; cell < CELLS; cell++) {
+        if (openingSize[cell] == 0) {
+            continue;
+        }
+        metrics->openingCells += openingSize[cell];
+        if (largestRoot < 0 || openingSize[cell] > openingSize[largestRoot]) {
+            largestRoot = cell;
+        }
+        if (metrics->smallestOpening == 0 || openingSize[cell] < metrics->smallestOpening) {
+            metrics->smallestOpening = openingSize[cell];
+        }
+    }
+
+    /* The first click is free: on the largest opening if there is one */
+    if (largestRoot >= 0) {
+        metrics->largestOpening = openingSize[largestRoot];
+        metrics->guesses = countGuesses(&solver, largestRoot);
+    } else if (solver.safeCells > 0) {
+        metrics->guesses = countGuesses(&solver, solverPick(&solver));
+    }
+}
+
+static int analyzeChunk(void* data) {
+    AnalyzeChunk* chunk = data;
+    int mineLocations[BOARD_ROWS][BOARD_COLS];
+    BoardMetrics metrics;
+
+    chunk->length = 0;
+    for (unsigned int i = 0; i < chunk->count; i++) {
+        unsigned int seed = chunk->firstSeed + i;
+        placeMines(mineLocations, BOARD_ROWS, BOARD_COLS, MINES, seed);
+        analyzeBoard(mineLocations, &metrics);
+
+        chunk->length += snprintf(chunk->buffer + chunk->length, ANALYZE_ROW_LENGTH,
+                                  "%u\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n", seed, metrics.bbbv,
+                                  metrics.openings, metrics.largestOpening, metrics.smallestOpening,
+                                  metrics.openingCells, metrics.openedCells, metrics.isolatedNumbers, metrics.guesses);
+    }
+    return 0;
+}
+
+int analyzeSeeds(unsigned int firstSeed, unsigned int count, int threads, FILE* out) {
+    if (count > 0 && count - 1 > UINT_MAX - firstSeed) {
+        fprintf(stderr, "Seed range runs past %u\n", UINT_MAX);
+        return 1;
+    }
+
+    /* No more workers than there are chunks to hand out */
+    unsigned int chunkCount = count / ANALYZE_CHUNK + (count % ANALYZE_CHUNK != 0);
+    threads = parallelThreads(threads, chunkCount < ANALYZE_MAX_THREADS ? chunkCount : ANALYZE_MAX_THREADS);
+
+    buildNeighbours();
+
+    size_t chunkSeeds = count < ANALYZE_CHUNK ? count : ANALYZE_CHUNK;
+    AnalyzeChunk chunks[threads];
+    for (int i = 0; i < threads; i++) {
+        chunks[i].buffer = malloc(chunkSeeds * ANALYZE_ROW_LENGTH + 1);
+        if (!chunks[i].buffer) {
+            fprintf(stderr, "Out of memory\n");
+            for (int j = 0; j < i; j++) {
+                free(chunks[j].buffer);
+            }
+            return 1;
+        }
+    }
+
+    fprintf(out, "seed\tbbbv\topenings\tlargest_opening\tsmallest_opening\topening_cells\topened_cells\tisolated_numbers\tguesses\n");
+
+    int ok = 1;
+    unsigned int done = 0;
+    while (done < count && ok) {
+        for (int i = 0; i < threads; i++) {
+            unsigned int left = count - done;
+            chunks[i].firstSeed = firstSeed + done;
+            chunks[i].count = left < ANALYZE_CHUNK ? left : ANALYZE_CHUNK;
+            chunks[i].length = 0;
+            done += chunks[i].count;
+        }
+        runParallel(analyzeChunk, chunks, sizeof(chunks[0]), threads, "analyzer");
+
+        for (int i = 0; i < threads; i++) {
+            if (ok && fwrite(chunks[i].buffer, 1, chunks[i].length, out) != chunks[i].length) {
+                fprintf(stderr, "Unable to write results\n");
+                ok = 0;
+            }
+        }
+    }
+
+    for (int i = 0; i < threads; i++) {
+        free(chunks[i].buffer);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include <stdio.h>
+#include "board.h"
+
+typedef struct {
+    int bbbv;            /* minimum left clicks to clear the board */
+    int openings;        /* zero regions, each opened by a single click */
+    int largestOpening;  /* cells uncovered by the biggest opening, border included */
+    int smallestOpening; /* same for the smallest; 0 if there are no openings */
+    int openingCells;    /* sizes of all openings added up, border included, so
+                            openingCells / openings is the mean size */
+    int openedCells;     /* cells uncovered by all openings together; a border
+                            cell shared by two openings counts once */
+    int isolatedNumbers; /* numbered cells no opening uncovers */
+    int guesses;         /* see analyzeBoard */
+} BoardMetrics;
+
+/* Finds the openings floodFill would uncover with one union-find pass over
+   the zero cells, and derives 3BV from them.
+
+   guesses estimates how often a player must click without certainty: a
+   solver that only uses single-cell rules (a number whose mines are all
+   flagged opens its other neighbours, a number with as many hidden
+   neighbours as missing mines flags them) starts from an opening and counts
+   every time it gets stuck. Positions that need wider reasoning count as
+   guesses too, so it is an upper bound. */
+void analyzeBoard(int mineLocations[][BOARD_COLS], BoardMetrics* metrics);
+
+/* Analyzes the boards for `count` seeds from `firstSeed` on `threads`
+   threads (one per CPU if <= 0) and writes one tab-separated row per seed,
+   in seed order. */
+int analyzeSeeds(unsigned int firstSeed, unsigned int count, int threads, FILE* out);
+
+#endif
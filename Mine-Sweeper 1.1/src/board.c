@@ -0,0 +1,75 @@
+#include <string.h>
+#include "board.h"
+
+int countAdjacentMines(int y, int x, int mineLocations[][BOARD_COLS], int cellsY, int cellsX) {
+	int count = 0;
+	for (int i = -1; i <= 1; i++) {
+		for (int j = -1; j <= 1; j++) {
+			int ny = y + i;
+			int nx = x + j;
+			if (ny >= 0 && ny < cellsY && nx >= 0 && nx < cellsX) {
+				count += mineLocations[ny][nx];
+			}
+		}
+	}
+	return count;
+}
+
+void floodFill(int cellStates[][BOARD_COLS], int mineLocations[][BOARD_COLS], int y, int x, int cellsY, int cellsX) {
+    if (y < 0 || y >= cellsY || x < 0 || x >= cellsX || cellStates[y][x] != CELL_HIDDEN) {
+        return;
+    }
+
+    int adjacentMines = countAdjacentMines(y, x, mineLocations, cellsY, cellsX);
+    cellStates[y][x] = CELL_OPEN;
+
+    if (adjacentMines == 0) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dy != 0 || dx != 0) {
+                    floodFill(cellStates, mineLocations, y + dy, x + dx, cellsY, cellsX);
+                }
+            }
+        }
+    }
+}
+
+/* xorshift32: small, reentrant and identical on every platform, unlike rand() */
+static unsigned int nextRandom(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+void placeMines(int mineLocations[][BOARD_COLS], int cellsY, int cellsX, int mines, unsigned int seed) {
+    unsigned int state = seed * 2654435761u ^ 0x9E3779B9u;
+    if (state == 0) {
+        state = 1;
+    }
+
+    memset(mineLocations, 0, sizeof(int) * BOARD_COLS * cellsY);
+
+    int minesPlaced = 0;
+    while (minesPlaced < mines) {
+        int x = nextRandom(&state) % cellsX;
+        int y = nextRandom(&state) % cellsY;
+        if (mineLocations[y][x] == 0) {
+            mineLocations[y][x] = 1;
+            minesPlaced++;
+        }
+    }
+}
+
+int boardCleared(int cellStates[][BOARD_COLS], int mineLocations[][BOARD_COLS], int cellsY, int cellsX) {
+    for (int y = 0; y < cellsY; y++) {
+        for (int x = 0; x < cellsX; x++) {
+            if (!mineLocations[y][x] && cellStates[y][x] != CELL_OPEN) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,27 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#define WINDOW_WIDTH 800
+#define WINDOW_HEIGHT 600
+#define CELL_SIZE 50
+#define MINES 40
+
+#define BOARD_COLS (WINDOW_WIDTH / CELL_SIZE)
+#define BOARD_ROWS (WINDOW_HEIGHT / CELL_SIZE)
+
+/* Cell states, as stored in cellStates */
+#define CELL_OPEN 0
+#define CELL_HIDDEN 1
+#define CELL_FLAGGED 2
+
+int countAdjacentMines(int y, int x, int mineLocations[][BOARD_COLS], int cellsY, int cellsX);
+void floodFill(int cellStates[][BOARD_COLS], int mineLocations[][BOARD_COLS], int y, int x, int cellsY, int cellsX);
+
+/* Places `mines` mines from `seed`. The same seed always gives the same board,
+   so games can be reproduced from the seed alone. */
+void placeMines(int mineLocations[][BOARD_COLS], int cellsY, int cellsX, int mines, unsigned int seed);
+
+/* True once every cell without a mine is open */
+int boardCleared(int cellStates[][BOARD_COLS], int mineLocations[][BOARD_COLS], int cellsY, int cellsX);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stddef.h>
+#include <SDL2/SDL.h>
+
+/* Start with crc = 0; feed the previous result back in to extend a checksum */
+Uint32 crc32Update(Uint32 crc, const void* data, size_t length);
+
+#endif
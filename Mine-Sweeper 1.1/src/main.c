@@ -1,14 +1,17 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_mixer.h>
 #include <GL/glew.h>
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
-
-#define WINDOW_WIDTH 800
-#define WINDOW_HEIGHT 600
-#define CELL_SIZE 50
-#define MINES 40
+#include "analyzer.h"
+#include "board.h"
+#include "softrender.h"
+#include "stats.h"
 
 const char* vertexShaderSource = R"(
 #version 460 core
@@ -105,20 +108,6 @@ GLuint loadTexture(const char* filename) {
 	return textureID;
 }
 
-int countAdjacentMines(int y, int x, int mineLocations[][WINDOW_WIDTH / CELL_SIZE], int cellsY, int cellsX) {
-	int count = 0;
-	for (int i = -1; i <= 1; i++) {
-		for (int j = -1; j <= 1; j++) {
-			int ny = y + i;
-			int nx = x + j;
-			if (ny >= 0 && ny < cellsY && nx >= 0 && nx < cellsX) {
-				count += mineLocations[ny][nx];
-			}
-		}
-	}
-	return count;
-}
-
 void renderGrid(GLuint shaderProgram, GLuint vao, GLuint texture, int cellsX, int cellsY) {
     glUseProgram(shaderProgram);
     
@@ -149,25 +138,6 @@ void renderGrid(GLuint shaderProgram, GLuint vao, GLuint texture, int cellsX, in
     glUseProgram(0);
 }
 
-void floodFill(int cellStates[][WINDOW_WIDTH / CELL_SIZE], int mineLocations[][WINDOW_WIDTH / CELL_SIZE], int y, int x, int cellsY, int cellsX) {
-    if (y < 0 || y >= cellsY || x < 0 || x >= cellsX || cellStates[y][x] != 1) {
-        return;
-    }
-
-    int adjacentMines = countAdjacentMines(y, x, mineLocations, cellsY, cellsX);
-    cellStates[y][x] = 0;
-
-    if (adjacentMines == 0) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            for (int dx = -1; dx <= 1; ++dx) {
-                if (dy != 0 || dx != 0) {
-                    floodFill(cellStates, mineLocations, y + dy, x + dx, cellsY, cellsX);
-                }
-            }
-        }
-    }
-}
-
 void renderTexture(GLuint shaderProgram, GLuint vao, GLuint texture, SDL_Rect* rect) {
 	glUseProgram(shaderProgram);
 	glBindTexture(GL_TEXTURE_2D, texture);
@@ -190,7 +160,129 @@ void renderTexture(GLuint shaderProgram, GLuint vao, GLuint texture, SDL_Rect* r
 	glUseProgram(0);
 }
 
-int main() {
+/* Parses a whole decimal argument in [min, max]. Signs, blanks and trailing
+   text are rejected rather than read as 0 or wrapped like strtoul does. */
+int parseNumber(const char* text, unsigned long min, unsigned long max, unsigned long* value) {
+    if (*text < '0' || *text > '9') {
+        return 0;
+    }
+
+    char* end;
+    errno = 0;
+    *value = strtoul(text, &end, 10);
+    return errno == 0 && *end == '\0' && *value >= min && *value <= max;
+}
+
+/* Seeds are 32-bit: FIRST_SEED..FIRST_SEED + COUNT - 1 must not wrap */
+int parseSeedRange(const char* firstText, const char* countText, unsigned int* first, unsigned int* count) {
+    unsigned long firstSeed, seedCount;
+    if (!parseNumber(firstText, 0, UINT_MAX, &firstSeed) ||
+        !parseNumber(countText, 1, UINT_MAX, &seedCount) ||
+        seedCount - 1 > UINT_MAX - firstSeed) {
+        return 0;
+    }
+
+    *first = firstSeed;
+    *count = seedCount;
+    return 1;
+}
+
+/* The render pattern ends up as a printf format, so it may only contain one
+   %u (for the seed) and literal %% */
+int validPattern(const char* pattern) {
+    int seeds = 0;
+    for (const char* c = pattern; *c; c++) {
+        if (*c != '%') {
+            continue;
+        }
+        c++;
+        if (*c == 'u') {
+            seeds++;
+        } else if (*c != '%') {
+            return 0;
+        }
+    }
+    return seeds == 1;
+}
+
+/* Prints the games played and the `count` fastest wins on this board */
+int printLeaderboard(int count) {
+    StatsStore stats;
+    if (statsOpen(&stats, "stats.log", "stats.idx") != 0) {
+        return 1;
+    }
+
+    GameRecord top[STATS_TOP_SIZE];
+    Uint32 played, won;
+    if (count > STATS_TOP_SIZE) {
+        count = STATS_TOP_SIZE;
+    }
+    count = statsTop(&stats, BOARD_COLS, BOARD_ROWS, MINES, top, count);
+    statsTotals(&stats, BOARD_COLS, BOARD_ROWS, MINES, &played, &won);
+    statsClose(&stats);
+
+    printf("%dx%d, %d mines: %u played, %u won\n", BOARD_COLS, BOARD_ROWS, MINES, played, won);
+    for (int i = 0; i < count; i++) {
+        time_t when = top[i].timestamp;
+        char date[32];
+        strftime(date, sizeof(date), "%Y-%m-%d %H:%M", localtime(&when));
+        printf("%3d. %4u.%03us  3BV %3u  clicks %3u  eff %3u%%  seed %10u  %s\n", i + 1,
+               top[i].durationMs / 1000, top[i].durationMs % 1000, top[i].bbbv, top[i].clicks,
+               top[i].efficiency, top[i].seed, date);
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && strcmp(argv[1], "--render") == 0) {
+        if (argc != 5 && argc != 6) {
+            fprintf(stderr, "Usage: %s --render FIRST_SEED COUNT PATTERN [TILE_SIZE]\n", argv[0]);
+            return 1;
+        }
+        unsigned int firstSeed, count;
+        if (!parseSeedRange(argv[2], argv[3], &firstSeed, &count)) {
+            fprintf(stderr, "FIRST_SEED and COUNT must be non-negative numbers, COUNT at least 1, and the range must end by seed %u\n", UINT_MAX);
+            return 1;
+        }
+        if (!validPattern(argv[4])) {
+            fprintf(stderr, "PATTERN needs exactly one %%u for the seed, and no other %% conversions\n");
+            return 1;
+        }
+        unsigned long tileSize = CELL_SIZE;
+        if (argc == 6 && !parseNumber(argv[5], 1, CELL_SIZE, &tileSize)) {
+            fprintf(stderr, "TILE_SIZE must be between 1 and %d\n", CELL_SIZE);
+            return 1;
+        }
+        return softRenderSeeds(firstSeed, count, tileSize, 0, argv[4]);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--analyze") == 0) {
+        if (argc != 4 && argc != 5) {
+            fprintf(stderr, "Usage: %s --analyze FIRST_SEED COUNT [THREADS]\n", argv[0]);
+            return 1;
+        }
+        unsigned int firstSeed, count;
+        unsigned long threads = 0;
+        if (!parseSeedRange(argv[2], argv[3], &firstSeed, &count)) {
+            fprintf(stderr, "FIRST_SEED and COUNT must be non-negative numbers, COUNT at least 1, and the range must end by seed %u\n", UINT_MAX);
+            return 1;
+        }
+        if (argc == 5 && !parseNumber(argv[4], 1, INT_MAX, &threads)) {
+            fprintf(stderr, "THREADS must be a positive number\n");
+            return 1;
+        }
+        return analyzeSeeds(firstSeed, count, threads, stdout);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--stats") == 0) {
+        unsigned long count = 10;
+        if (argc >= 3) {
+            if (!parseNumber(argv[2], 1, ULONG_MAX, &count)) {
+                fprintf(stderr, "Usage: %s --stats [COUNT]  (COUNT must be a positive number)\n", argv[0]);
+                return 1;
+            }
+        }
+        return printLeaderboard(count > STATS_TOP_SIZE ? STATS_TOP_SIZE : count);
+    }
+
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         fprintf(stderr, "SDL2 : %s\n", SDL_GetError());
         return 1;
@@ -260,7 +352,6 @@ int main() {
     int cellStates[cellsY][cellsX];
     int mineLocations[cellsY][cellsX];
     int flaggedCells[cellsY][cellsX];
-    memset(mineLocations, 0, sizeof(mineLocations));
     memset(flaggedCells, 0, sizeof(flaggedCells));
 
     for (int y = 0; y < cellsY; y++) {
@@ -269,17 +360,21 @@ int main() {
 	    }
     }
 
-    srand(time(NULL));
-    int minesPlaced = 0;
+    unsigned int seed = time(NULL);
+    placeMines(mineLocations, cellsY, cellsX, MINES, seed);
 
-    while (minesPlaced < MINES) {
-        int x = rand() % cellsX;
-        int y = rand() % cellsY;
-        if (mineLocations[y][x] == 0) {
-            mineLocations[y][x] = 1;
-            minesPlaced++;
-        }
-    }
+    /* The game still runs if the stats files can't be opened */
+    StatsStore stats;
+    int statsOpened = statsOpen(&stats, "stats.log", "stats.idx") == 0;
+
+    GameRecord result;
+    memset(&result, 0, sizeof(result));
+    result.seed = seed;
+    result.width = cellsX;
+    result.height = cellsY;
+    result.mines = MINES;
+    int finished = 0;
+    Uint32 startTicks = 0;
 
     
     GLuint shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
@@ -338,12 +433,18 @@ int main() {
 			    int cellX = mouseX / CELL_SIZE;
 			    int cellY = mouseY / CELL_SIZE;
 
-			    if (cellX >= 0 && cellX < cellsX && cellY >= 0 && cellY < cellsY) {
+			    if (!finished && cellX >= 0 && cellX < cellsX && cellY >= 0 && cellY < cellsY) {
+				if (result.clicks++ == 0) {
+					startTicks = SDL_GetTicks();
+				}
+
 				if (event.button.button == SDL_BUTTON_LEFT) {
 					if (cellStates[cellY][cellX] != 2) {
 						if (mineLocations[cellY][cellX] == 1) {
 							rect.x = cellX * CELL_SIZE;
 							rect.y = cellY * CELL_SIZE;
+							result.durationMs = SDL_GetTicks() - startTicks;
+							finished = 1;
 							renderTexture(shaderProgram, vao, mine, &rect);
 							SDL_GL_SwapWindow(window);
 							Mix_PlayChannel(-1, soundEffect[0], 0);
@@ -358,6 +459,15 @@ int main() {
 							} else {
 								cellStates[cellY][cellX] = 0;
 							}
+
+							if (boardCleared(cellStates, mineLocations, cellsY, cellsX)) {
+								result.durationMs = SDL_GetTicks() - startTicks;
+								result.won = 1;
+								finished = 1;
+								SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Game over", "You won !", window);
+
+								running = 0;
+							}
 				 		}
 					}
 				} else if (event.button.button == SDL_BUTTON_RIGHT) {
@@ -412,6 +522,17 @@ int main() {
    	    SDL_GL_SwapWindow(window);
     }
 
+    if (statsOpened) {
+        if (finished) {
+            result.timestamp = time(NULL);
+            BoardMetrics metrics;
+            analyzeBoard(mineLocations, &metrics);
+            result.bbbv = metrics.bbbv;
+            statsRecord(&stats, &result);
+        }
+        statsClose(&stats);
+    }
+
     glDeleteBuffers(1, &vbo);
     glDeleteVertexArrays(1, &vao);
     glDeleteProgram(shaderProgram);
@@ -0,0 +1,33 @@
+#include "parallel.h"
+
+int parallelThreads(int threads, unsigned int limit) {
+    if (threads <= 0) {
+        threads = SDL_GetCPUCount();
+    }
+    if (threads > 0 && (unsigned int)threads > limit) {
+        threads = limit;
+    }
+    return threads > 0 ? threads : 1;
+}
+
+void runParallel(SDL_ThreadFunction fn, void* jobs, size_t stride, int count, const char* name) {
+    if (count <= 0) {
+        return;
+    }
+
+    Uint8* job = jobs;
+    SDL_Thread* workers[count];
+
+    for (int i = 1; i < count; i++) {
+        workers[i] = SDL_CreateThread(fn, name, job + i * stride);
+        if (!workers[i]) {
+            fn(job + i * stride);
+        }
+    }
+    fn(job);
+    for (int i = 1; i < count; i++) {
+        if (workers[i]) {
+            SDL_WaitThread(workers[i], NULL);
+        }
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+#include <SDL2/SDL.h>
+
+/* Number of workers for a request of `threads` (one per CPU if <= 0), never
+   more than `limit` and never less than 1 */
+int parallelThreads(int threads, unsigned int limit);
+
+/* Calls `fn` on each of the `count` jobs laid out `stride` bytes apart from
+   `jobs` and returns once all have finished. Job 0 runs on the calling
+   thread, the rest on threads of their own; a job whose thread cannot be
+   created runs on the calling thread instead. */
+void runParallel(SDL_ThreadFunction fn, void* jobs, size_t stride, int count, const char* name);
+
+#endif
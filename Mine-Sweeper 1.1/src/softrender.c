@@ -0,0 +1,430 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "checksum.h"
+#include "parallel.h"
+#include "softrender.h"
+
+static const char* tileFiles[TILE_COUNT] = {
+    "textures/cube.bmp",
+    "textures/flag.bmp",
+    "textures/mine.bmp",
+    "textures/one.bmp",
+    "textures/two.bmp",
+    "textures/three.bmp",
+    "textures/four.bmp",
+    "textures/five.bmp",
+    "textures/six.bmp",
+};
+
+/* Same value as the glClearColor used by the windowed renderer */
+#define BACKGROUND_PIXEL 0xFF828282u
+
+typedef struct {
+    unsigned int firstSeed;
+    unsigned int count;
+    int tileSize;
+    const char* pattern;
+    int result;
+} RenderJob;
+
+typedef struct {
+    SoftRenderer* renderer;
+    const Uint32* (*cellTiles)[BOARD_COLS];
+    int firstRow;
+    int lastRow;
+} RenderBand;
+
+/* Averages every block of source pixels that lands on one destination pixel.
+   Plain nearest-neighbour sampling would drop most of the digit strokes at
+   thumbnail sizes. */
+static SDL_Surface* shrinkTile(SDL_Surface* source, int size) {
+    SDL_Surface* shrunk = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!shrunk) {
+        fprintf(stderr, "SDL2: %s\n", SDL_GetError());
+        return NULL;
+    }
+
+    for (int y = 0; y < size; y++) {
+        Uint32* dst = (Uint32*)((Uint8*)shrunk->pixels + y * shrunk->pitch);
+        int firstY = y * source->h / size;
+        int lastY = (y + 1) * source->h / size;
+
+        for (int x = 0; x < size; x++) {
+            int firstX = x * source->w / size;
+            int lastX = (x + 1) * source->w / size;
+            Uint32 sum[4] = {0, 0, 0, 0};
+
+            for (int sy = firstY; sy < lastY; sy++) {
+                const Uint32* src = (const Uint32*)((const Uint8*)source->pixels + sy * source->pitch);
+                for (int sx = firstX; sx < lastX; sx++) {
+                    for (int c = 0; c < 4; c++) {
+                        sum[c] += (src[sx] >> (c * 8)) & 0xFF;
+                    }
+                }
+            }
+
+            Uint32 area = (lastY - firstY) * (lastX - firstX);
+            Uint32 pixel = 0;
+            for (int c = 0; c < 4; c++) {
+                pixel |= ((sum[c] + area / 2) / area) << (c * 8);
+            }
+            dst[x] = pixel;
+        }
+    }
+
+    return shrunk;
+}
+
+static SDL_Surface* loadTile(const char* filename, int size) {
+    SDL_Surface* surface = SDL_LoadBMP(filename);
+    if (!surface) {
+        fprintf(stderr, "Unable to load texture: %s\n", filename);
+        return NULL;
+    }
+
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(surface);
+    if (!converted) {
+        fprintf(stderr, "SDL2: %s\n", SDL_GetError());
+        return NULL;
+    }
+
+    SDL_Surface* scaled = converted;
+    if (converted->w != CELL_SIZE || converted->h != CELL_SIZE) {
+        /* The GL path stretches textures over the quad, do the same once here */
+        scaled = SDL_CreateRGBSurfaceWithFormat(0, CELL_SIZE, CELL_SIZE, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (scaled) {
+            SDL_SetSurfaceBlendMode(converted, SDL_BLENDMODE_NONE);
+            SDL_BlitScaled(converted, NULL, scaled, NULL);
+        }
+        SDL_FreeSurface(converted);
+    }
+    if (!scaled || size == CELL_SIZE) {
+        return scaled;
+    }
+
+    SDL_Surface* shrunk = shrinkTile(scaled, size);
+    SDL_FreeSurface(scaled);
+    return shrunk;
+}
+
+int softRendererInit(SoftRenderer* renderer, int tileSize, int threads) {
+    memset(renderer, 0, sizeof(*renderer));
+
+    if (tileSize < 1 || tileSize > CELL_SIZE) {
+        fprintf(stderr, "Tile size must be between 1 and %d\n", CELL_SIZE);
+        return 1;
+    }
+    renderer->tileSize = tileSize;
+
+    for (int i = 0; i < TILE_COUNT; i++) {
+        renderer->tiles[i] = loadTile(tileFiles[i], tileSize);
+        if (!renderer->tiles[i]) {
+            softRendererDestroy(renderer);
+            return 1;
+        }
+    }
+
+    renderer->frame = SDL_CreateRGBSurfaceWithFormat(0, BOARD_COLS * tileSize, BOARD_ROWS * tileSize, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!renderer->frame) {
+        fprintf(stderr, "SDL2: %s\n", SDL_GetError());
+        softRendererDestroy(renderer);
+        return 1;
+    }
+
+    for (int i = 0; i < tileSize; i++) {
+        renderer->background[i] = BACKGROUND_PIXEL;
+    }
+
+    renderer->threads = threads > 0 ? parallelThreads(threads, renderer->frame->h) : 1;
+
+    return 0;
+}
+
+void softRendererDestroy(SoftRenderer* renderer) {
+    for (int i = 0; i < TILE_COUNT; i++) {
+        if (renderer->tiles[i]) {
+            SDL_FreeSurface(renderer->tiles[i]);
+            renderer->tiles[i] = NULL;
+        }
+    }
+    if (renderer->frame) {
+        SDL_FreeSurface(renderer->frame);
+        renderer->frame = NULL;
+    }
+}
+
+/* Every tile row is a straight copy of tileSize pixels (no blending in the
+   GL path either), so a band is nothing but aligned memcpy calls, which libc
+   already runs with the widest SIMD moves the CPU has. */
+static int renderBand(void* data) {
+    RenderBand* band = data;
+    SoftRenderer* renderer = band->renderer;
+    Uint8* pixels = renderer->frame->pixels;
+    int pitch = renderer->frame->pitch;
+    int tilePitch = renderer->tiles[0]->pitch / sizeof(Uint32);
+    int tileSize = renderer->tileSize;
+
+    for (int y = band->firstRow; y < band->lastRow; y++) {
+        Uint32* dst = (Uint32*)(pixels + y * pitch);
+        int cellY = y / tileSize;
+        int tileY = y % tileSize;
+
+        for (int x = 0; x < BOARD_COLS; x++) {
+            const Uint32* tile = band->cellTiles[cellY][x];
+            const Uint32* src = tile ? tile + tileY * tilePitch : renderer->background;
+            memcpy(dst + x * tileSize, src, tileSize * sizeof(Uint32));
+        }
+    }
+
+    return 0;
+}
+
+static int tileFor(int cellState, int isMine, int adjacentMines, int revealMines) {
+    if (cellState == CELL_FLAGGED) {
+        return TILE_FLAG;
+    }
+    if (cellState == CELL_HIDDEN) {
+        return (revealMines && isMine) ? TILE_MINE : TILE_CELL;
+    }
+    if (isMine) {
+        return TILE_MINE;
+    }
+    if (adjacentMines >= 1 && adjacentMines <= 6) {
+        return TILE_ONE + adjacentMines - 1;
+    }
+    return -1;
+}
+
+void softRenderBoard(SoftRenderer* renderer, int cellStates[][BOARD_COLS], int mineLocations[][BOARD_COLS], int revealMines) {
+    const Uint32* cellTiles[BOARD_ROWS][BOARD_COLS];
+
+    for (int y = 0; y < BOARD_ROWS; y++) {
+        for (int x = 0; x < BOARD_COLS; x++) {
+            int adjacentMines = countAdjacentMines(y, x, mineLocations, BOARD_ROWS, BOARD_COLS);
+            int tile = tileFor(cellStates[y][x], mineLocations[y][x], adjacentMines, revealMines);
+            cellTiles[y][x] = tile < 0 ? NULL : renderer->tiles[tile]->pixels;
+        }
+    }
+
+    int threads = renderer->threads;
+    RenderBand bands[threads];
+
+    for (int i = 0; i < threads; i++) {
+        bands[i].renderer = renderer;
+        bands[i].cellTiles = cellTiles;
+        bands[i].firstRow = renderer->frame->h * i / threads;
+        bands[i].lastRow = renderer->frame->h * (i + 1) / threads;
+    }
+    runParallel(renderBand, bands, sizeof(bands[0]), threads, "softrender");
+}
+
+static void putBigEndian(Uint8* dst, Uint32 value) {
+    dst[0] = value >> 24;
+    dst[1] = value >> 16;
+    dst[2] = value >> 8;
+    dst[3] = value;
+}
+
+static int writeChunk(FILE* file, const char* type, const Uint8* data, Uint32 length) {
+    Uint8 header[8];
+    Uint8 footer[4];
+
+    putBigEndian(header, length);
+    memcpy(header + 4, type, 4);
+    putBigEndian(footer, crc32Update(crc32Update(0, header + 4, 4), data, length));
+
+    return fwrite(header, 1, 8, file) == 8 &&
+           fwrite(data, 1, length, file) == length &&
+           fwrite(footer, 1, 4, file) == 4;
+}
+
+/* Uncompressed (stored deflate blocks) PNG: no zlib dependency, and writing
+   is bound by I/O rather than compression when dumping thousands of frames. */
+static int savePNG(SDL_Surface* frame, const char* filename) {
+    static const Uint8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    const Uint32 rowLength = 1 + frame->w * 3;
+    const Uint32 rawLength = rowLength * frame->h;
+    const Uint32 blocks = (rawLength + 65534) / 65535;
+    const Uint32 idatLength = 2 + blocks * 5 + rawLength + 4;
+
+    Uint8* idat = malloc(idatLength);
+    if (!idat) {
+        fprintf(stderr, "Out of memory writing %s\n", filename);
+        return 1;
+    }
+
+    /* Filter byte (none) + RGB for every row */
+    Uint8* raw = malloc(rawLength);
+    if (!raw) {
+        free(idat);
+        fprintf(stderr, "Out of memory writing %s\n", filename);
+        return 1;
+    }
+    for (int y = 0; y < frame->h; y++) {
+        const Uint32* src = (const Uint32*)((const Uint8*)frame->pixels + y * frame->pitch);
+        Uint8* dst = raw + y * rowLength;
+        *dst++ = 0;
+        for (int x = 0; x < frame->w; x++) {
+            *dst++ = src[x] >> 16;
+            *dst++ = src[x] >> 8;
+            *dst++ = src[x];
+        }
+    }
+
+    Uint8* out = idat;
+    *out++ = 0x78;
+    *out++ = 0x01;
+    Uint32 adlerA = 1, adlerB = 0;
+    for (Uint32 offset = 0; offset < rawLength; offset += 65535) {
+        Uint32 length = rawLength - offset < 65535 ? rawLength - offset : 65535;
+        *out++ = offset + length == rawLength;
+        *out++ = length;
+        *out++ = length >> 8;
+        *out++ = ~length;
+        *out++ = ~length >> 8;
+        memcpy(out, raw + offset, length);
+        out += length;
+    }
+    /* 5552 is the longest run that cannot overflow adlerB before the modulo */
+    for (Uint32 offset = 0; offset < rawLength; offset += 5552) {
+        Uint32 end = rawLength - offset < 5552 ? rawLength : offset + 5552;
+        for (Uint32 i = offset; i < end; i++) {
+            adlerA += raw[i];
+            adlerB += adlerA;
+        }
+        adlerA %= 65521;
+        adlerB %= 65521;
+    }
+    putBigEndian(out, (adlerB << 16) | adlerA);
+    free(raw);
+
+    Uint8 ihdr[13];
+    putBigEndian(ihdr, frame->w);
+    putBigEndian(ihdr + 4, frame->h);
+    ihdr[8] = 8;
+    ihdr[9] = 2;
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        free(idat);
+        fprintf(stderr, "Unable to open %s\n", filename);
+        return 1;
+    }
+
+    int ok = fwrite(signature, 1, 8, file) == 8 &&
+             writeChunk(file, "IHDR", ihdr, sizeof(ihdr)) &&
+             writeChunk(file, "IDAT", idat, idatLength) &&
+             writeChunk(file, "IEND", NULL, 0);
+    free(idat);
+
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "Unable to write %s\n", filename);
+        return 1;
+    }
+    return 0;
+}
+
+static int saveRaw(SDL_Surface* frame, const char* filename) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        fprintf(stderr, "Unable to open %s\n", filename);
+        return 1;
+    }
+
+    int ok = 1;
+    for (int y = 0; y < frame->h && ok; y++) {
+        const Uint8* row = (const Uint8*)frame->pixels + y * frame->pitch;
+        ok = fwrite(row, sizeof(Uint32), frame->w, file) == (size_t)frame->w;
+    }
+
+    if (fclose(file) != 0 || !ok) {
+        fprintf(stderr, "Unable to write %s\n", filename);
+        return 1;
+    }
+    return 0;
+}
+
+static int hasExtension(const char* filename, const char* extension) {
+    size_t length = strlen(filename);
+    size_t extensionLength = strlen(extension);
+    return length >= extensionLength && SDL_strcasecmp(filename + length - extensionLength, extension) == 0;
+}
+
+int softRendererSave(SoftRenderer* renderer, const char* filename) {
+    if (hasExtension(filename, ".png")) {
+        return savePNG(renderer->frame, filename);
+    }
+    if (hasExtension(filename, ".bmp")) {
+        if (SDL_SaveBMP(renderer->frame, filename) < 0) {
+            fprintf(stderr, "SDL2: %s\n", SDL_GetError());
+            return 1;
+        }
+        return 0;
+    }
+    return saveRaw(renderer->frame, filename);
+}
+
+static int renderJob(void* data) {
+    RenderJob* job = data;
+    SoftRenderer renderer;
+    int cellStates[BOARD_ROWS][BOARD_COLS];
+    int mineLocations[BOARD_ROWS][BOARD_COLS];
+    char filename[4096];
+
+    /* Parallelism comes from the other jobs, so one band per frame */
+    job->result = softRendererInit(&renderer, job->tileSize, 1);
+    if (job->result != 0) {
+        return job->result;
+    }
+
+    for (int y = 0; y < BOARD_ROWS; y++) {
+        for (int x = 0; x < BOARD_COLS; x++) {
+            cellStates[y][x] = CELL_OPEN;
+        }
+    }
+
+    for (unsigned int i = 0; i < job->count && job->result == 0; i++) {
+        unsigned int seed = job->firstSeed + i;
+        placeMines(mineLocations, BOARD_ROWS, BOARD_COLS, MINES, seed);
+        softRenderBoard(&renderer, cellStates, mineLocations, 1);
+
+        snprintf(filename, sizeof(filename), job->pattern, seed);
+        job->result = softRendererSave(&renderer, filename);
+    }
+
+    softRendererDestroy(&renderer);
+    return job->result;
+}
+
+int softRenderSeeds(unsigned int firstSeed, unsigned int count, int tileSize, int threads, const char* pattern) {
+    if (count > 0 && count - 1 > UINT_MAX - firstSeed) {
+        fprintf(stderr, "Seed range runs past %u\n", UINT_MAX);
+        return 1;
+    }
+
+    threads = parallelThreads(threads, count);
+    RenderJob jobs[threads];
+
+    for (int i = 0; i < threads; i++) {
+        unsigned int first = (Uint64)count * i / threads;
+        unsigned int last = (Uint64)count * (i + 1) / threads;
+        jobs[i].firstSeed = firstSeed + first;
+        jobs[i].count = last - first;
+        jobs[i].tileSize = tileSize;
+        jobs[i].pattern = pattern;
+        jobs[i].result = 0;
+    }
+    runParallel(renderJob, jobs, sizeof(jobs[0]), threads, "softrender");
+
+    int result = 0;
+    for (int i = 0; i < threads; i++) {
+        result |= jobs[i].result;
+    }
+    return result;
+}
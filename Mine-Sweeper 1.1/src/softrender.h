@@ -0,0 +1,57 @@
+#ifndef SOFTRENDER_H
+#define SOFTRENDER_H
+
+#include <SDL2/SDL.h>
+#include "board.h"
+
+/* CPU rasterizer for the board. Needs no window or GL context, so it runs on
+   headless machines, e.g. to make board thumbnails. */
+
+enum {
+    TILE_CELL,
+    TILE_FLAG,
+    TILE_MINE,
+    TILE_ONE,
+    TILE_TWO,
+    TILE_THREE,
+    TILE_FOUR,
+    TILE_FIVE,
+    TILE_SIX,
+    TILE_COUNT
+};
+
+typedef struct {
+    SDL_Surface* tiles[TILE_COUNT];
+    SDL_Surface* frame;
+    Uint32 background[CELL_SIZE];
+    int tileSize;
+    int threads;
+} SoftRenderer;
+
+/* Every cell is drawn `tileSize` pixels square, from 1 up to CELL_SIZE (the
+   window's own size); smaller tiles are box-filtered down from the textures
+   once here, so thumbnails cost no more per frame than their pixel count.
+
+   Threads softRenderBoard splits a single frame over; <= 0 means 1. A frame
+   is only a few hundred microseconds of memcpy, so bands are opt-in for
+   one-off renders: batch work such as softRenderSeeds is faster running
+   whole frames side by side. */
+int softRendererInit(SoftRenderer* renderer, int tileSize, int threads);
+void softRendererDestroy(SoftRenderer* renderer);
+
+/* Draws the board exactly as the GL path does. With revealMines set, hidden
+   cells are drawn as they would be after the game ended. */
+void softRenderBoard(SoftRenderer* renderer, int cellStates[][BOARD_COLS], int mineLocations[][BOARD_COLS], int revealMines);
+
+/* Writes the current frame; the format is picked from the extension
+   (.png, .bmp, anything else is raw ARGB8888). */
+int softRendererSave(SoftRenderer* renderer, const char* filename);
+
+/* Renders `count` fully revealed boards from `firstSeed` to files named by
+   `pattern`, a printf format with one %u for the seed, e.g.
+   "thumbs/board-%u.png", with cells `tileSize` pixels square. The seeds are split over `threads` workers (one
+   per CPU if <= 0), each with its own renderer, so saving runs in parallel
+   too. */
+int softRenderSeeds(unsigned int firstSeed, unsigned int count, int tileSize, int threads, const char* pattern);
+
+#endif
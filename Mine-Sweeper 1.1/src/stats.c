@@ -0,0 +1,408 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include "checksum.h"
+#include "stats.h"
+
+static const char logMagic[8] = { 'M', 'S', 'S', 'T', 'A', 'T', 'S', '1' };
+static const char indexMagic[8] = { 'M', 'S', 'I', 'N', 'D', 'E', 'X', '1' };
+
+typedef struct {
+    char magic[8];
+    Uint64 logOffset;
+    Uint32 groupCount;
+    Uint32 checksum;
+} IndexHeader;
+
+static Uint32 recordChecksum(const GameRecord* record) {
+    return crc32Update(0, record, offsetof(GameRecord, checksum));
+}
+
+static Uint32 indexChecksum(const IndexHeader* header, const StatsGroup* groups) {
+    Uint32 crc = crc32Update(0, header, offsetof(IndexHeader, checksum));
+    return crc32Update(crc, groups, sizeof(StatsGroup) * header->groupCount);
+}
+
+static int syncFile(FILE* file) {
+    if (fflush(file) != 0) {
+        return 1;
+    }
+    return fdatasync(fileno(file));
+}
+
+static StatsGroup* findGroup(StatsStore* store, int width, int height, int mines) {
+    for (int i = 0; i < store->groupCount; i++) {
+        StatsGroup* group = &store->groups[i];
+        if (group->width == width && group->height == height && group->mines == mines) {
+            return group;
+        }
+    }
+    return NULL;
+}
+
+/* Only ever called with the mutex held, or before the writer thread exists */
+static int applyRecord(StatsStore* store, const GameRecord* record) {
+    StatsGroup* group = findGroup(store, record->width, record->height, record->mines);
+    if (!group) {
+        StatsGroup* groups = realloc(store->groups, sizeof(StatsGroup) * (store->groupCount + 1));
+        if (!groups) {
+            return 1;
+        }
+        store->groups = groups;
+        group = &groups[store->groupCount++];
+        memset(group, 0, sizeof(*group));
+        group->width = record->width;
+        group->height = record->height;
+        group->mines = record->mines;
+    }
+
+    group->played++;
+    if (!record->won) {
+        return 0;
+    }
+    group->won++;
+
+    int position = group->count;
+    while (position > 0 && group->top[position - 1].durationMs > record->durationMs) {
+        position--;
+    }
+    if (position >= STATS_TOP_SIZE) {
+        return 0;
+    }
+
+    int moved = group->count - position;
+    if (group->count == STATS_TOP_SIZE) {
+        moved--;
+    } else {
+        group->count++;
+    }
+    memmove(&group->top[position + 1], &group->top[position], sizeof(GameRecord) * moved);
+    group->top[position] = *record;
+    return 0;
+}
+
+static int loadIndex(StatsStore* store) {
+    FILE* file = fopen(store->indexPath, "rb");
+    if (!file) {
+        return 1;
+    }
+
+    IndexHeader header;
+    StatsGroup* groups = NULL;
+    int ok = fread(&header, sizeof(header), 1, file) == 1 &&
+             memcmp(header.magic, indexMagic, sizeof(indexMagic)) == 0;
+
+    if (ok && header.groupCount > 0) {
+        groups = malloc(sizeof(StatsGroup) * header.groupCount);
+        ok = groups && fread(groups, sizeof(StatsGroup), header.groupCount, file) == header.groupCount;
+    }
+    fclose(file);
+
+    if (!ok || indexChecksum(&header, groups) != header.checksum) {
+        free(groups);
+        return 1;
+    }
+
+    free(store->groups);
+    store->groups = groups;
+    store->groupCount = header.groupCount;
+    store->logOffset = header.logOffset;
+    return 0;
+}
+
+/* Checkpoint: write the index next to the old one and rename it over, so a
+   crash leaves either the previous index or the new one, never half of one.
+   The caller holds the log lock and has replayed the log up to its end, so
+   the index matches the log even with several instances writing to it.
+   Called from the writer thread only, which is the only thread that changes
+   the groups, so it can read them without the mutex. */
+static int saveIndex(StatsStore* store) {
+    size_t length = strlen(store->indexPath) + 32;
+    char tempPath[length];
+    snprintf(tempPath, length, "%s.%d.tmp", store->indexPath, (int)getpid());
+
+    IndexHeader header;
+    memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.logOffset = store->logOffset;
+    header.groupCount = store->groupCount;
+    header.checksum = indexChecksum(&header, store->groups);
+
+    FILE* file = fopen(tempPath, "wb");
+    if (!file) {
+        fprintf(stderr, "Stats: unable to write %s\n", tempPath);
+        return 1;
+    }
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(store->groups, sizeof(StatsGroup), store->groupCount, file) == (size_t)store->groupCount &&
+             syncFile(file) == 0;
+    ok = fclose(file) == 0 && ok;
+
+    if (!ok || rename(tempPath, store->indexPath) != 0) {
+        fprintf(stderr, "Stats: unable to write %s\n", store->indexPath);
+        remove(tempPath);
+        return 1;
+    }
+
+    store->sinceCheckpoint = 0;
+    return 0;
+}
+
+/* Applies every record between logOffset and the end of the log, including
+   the ones other instances appended. Must be called with the log locked.
+   Records are fixed-size and each has its own CRC, so a damaged record is
+   skipped; only a short record at the very end, a write cut off by a crash,
+   is cut from the log. */
+static int replayLog(StatsStore* store) {
+    if (fseek(store->log, store->logOffset, SEEK_SET) != 0) {
+        return 1;
+    }
+
+    GameRecord record;
+    size_t length;
+    while ((length = fread(&record, 1, sizeof(record), store->log)) == sizeof(record)) {
+        if (recordChecksum(&record) != record.checksum) {
+            fprintf(stderr, "Stats: skipping a damaged record in the log\n");
+            store->logOffset += sizeof(record);
+            continue;
+        }
+
+        if (store->mutex) {
+            SDL_LockMutex(store->mutex);
+        }
+        int failed = applyRecord(store, &record);
+        if (store->mutex) {
+            SDL_UnlockMutex(store->mutex);
+        }
+        if (failed) {
+            return 1;
+        }
+        store->logOffset += sizeof(record);
+        store->sinceCheckpoint++;
+    }
+
+    if (length > 0) {
+        fprintf(stderr, "Stats: dropping a partial record at the end of the log\n");
+        if (fflush(store->log) != 0 || ftruncate(fileno(store->log), store->logOffset) != 0) {
+            return 1;
+        }
+    }
+    clearerr(store->log);
+    return fseek(store->log, 0, SEEK_END);
+}
+
+/* Appends one record while holding the log lock. Records other instances
+   appended are applied first, and logOffset is taken from the file size
+   afterwards, so logOffset and the groups always describe the same records.
+   Called from the writer thread only. */
+static void appendRecord(StatsStore* store, const GameRecord* record) {
+    if (flock(fileno(store->log), LOCK_EX) != 0) {
+        fprintf(stderr, "Stats: unable to lock the log\n");
+        return;
+    }
+
+    if (replayLog(store) != 0) {
+        fprintf(stderr, "Stats: unable to read the log\n");
+        flock(fileno(store->log), LOCK_UN);
+        return;
+    }
+
+    struct stat status;
+    int ok = fwrite(record, sizeof(*record), 1, store->log) == 1 &&
+             syncFile(store->log) == 0 &&
+             fstat(fileno(store->log), &status) == 0;
+
+    if (ok) {
+        SDL_LockMutex(store->mutex);
+        applyRecord(store, record);
+        SDL_UnlockMutex(store->mutex);
+        store->logOffset = status.st_size;
+        store->sinceCheckpoint++;
+
+        if (store->sinceCheckpoint >= STATS_CHECKPOINT_INTERVAL) {
+            saveIndex(store);
+        }
+    } else {
+        /* Cut any partial record so later appends stay readable */
+        clearerr(store->log);
+        if (ftruncate(fileno(store->log), store->logOffset) != 0) {
+            fprintf(stderr, "Stats: unable to repair the log\n");
+        }
+        fprintf(stderr, "Stats: unable to append to the log\n");
+    }
+
+    flock(fileno(store->log), LOCK_UN);
+}
+
+static int writerThread(void* data) {
+    StatsStore* store = data;
+
+    SDL_LockMutex(store->mutex);
+    for (;;) {
+        while (store->queueLength == 0 && !store->stopping) {
+            SDL_CondWait(store->wake, store->mutex);
+        }
+        if (store->queueLength == 0) {
+            break;
+        }
+
+        GameRecord record = store->queue[store->queueHead];
+        store->queueHead = (store->queueHead + 1) % STATS_QUEUE_SIZE;
+        store->queueLength--;
+        SDL_UnlockMutex(store->mutex);
+
+        appendRecord(store, &record);
+
+        SDL_LockMutex(store->mutex);
+    }
+    SDL_UnlockMutex(store->mutex);
+
+    if (flock(fileno(store->log), LOCK_EX) == 0) {
+        if (replayLog(store) == 0 && store->sinceCheckpoint > 0) {
+            saveIndex(store);
+        }
+        flock(fileno(store->log), LOCK_UN);
+    }
+    return 0;
+}
+
+static void freeStore(StatsStore* store) {
+    if (store->log) {
+        fclose(store->log);
+    }
+    if (store->wake) {
+        SDL_DestroyCond(store->wake);
+    }
+    if (store->mutex) {
+        SDL_DestroyMutex(store->mutex);
+    }
+    free(store->groups);
+    free(store->indexPath);
+    memset(store, 0, sizeof(*store));
+}
+
+int statsOpen(StatsStore* store, const char* logPath, const char* indexPath) {
+    memset(store, 0, sizeof(*store));
+
+    store->log = fopen(logPath, "a+b");
+    store->indexPath = strdup(indexPath);
+    if (!store->log || !store->indexPath) {
+        fprintf(stderr, "Stats: unable to open %s\n", logPath);
+        freeStore(store);
+        return 1;
+    }
+
+    /* Held until the log is replayed: another instance may be appending */
+    if (flock(fileno(store->log), LOCK_EX) != 0) {
+        fprintf(stderr, "Stats: unable to lock %s\n", logPath);
+        freeStore(store);
+        return 1;
+    }
+
+    fseek(store->log, 0, SEEK_END);
+    long logSize = ftell(store->log);
+    if (logSize == 0) {
+        if (fwrite(logMagic, sizeof(logMagic), 1, store->log) != 1 || syncFile(store->log) != 0) {
+            fprintf(stderr, "Stats: unable to write %s\n", logPath);
+            freeStore(store);
+            return 1;
+        }
+        logSize = sizeof(logMagic);
+    } else {
+        char magic[sizeof(logMagic)];
+        rewind(store->log);
+        if (fread(magic, sizeof(magic), 1, store->log) != 1 || memcmp(magic, logMagic, sizeof(logMagic)) != 0) {
+            fprintf(stderr, "Stats: %s is not a stats log\n", logPath);
+            freeStore(store);
+            return 1;
+        }
+    }
+
+    /* A missing or stale index is rebuilt from the whole log */
+    if (loadIndex(store) != 0 || store->logOffset < sizeof(logMagic) ||
+        store->logOffset > (Uint64)logSize ||
+        (store->logOffset - sizeof(logMagic)) % sizeof(GameRecord) != 0) {
+        free(store->groups);
+        store->groups = NULL;
+        store->groupCount = 0;
+        store->logOffset = sizeof(logMagic);
+    }
+
+    if (replayLog(store) != 0) {
+        fprintf(stderr, "Stats: unable to read %s\n", logPath);
+        freeStore(store);
+        return 1;
+    }
+    flock(fileno(store->log), LOCK_UN);
+
+    store->mutex = SDL_CreateMutex();
+    store->wake = SDL_CreateCond();
+    if (store->mutex && store->wake) {
+        store->writer = SDL_CreateThread(writerThread, "stats", store);
+    }
+    if (!store->writer) {
+        fprintf(stderr, "SDL2: %s\n", SDL_GetError());
+        freeStore(store);
+        return 1;
+    }
+    return 0;
+}
+
+void statsClose(StatsStore* store) {
+    SDL_LockMutex(store->mutex);
+    store->stopping = 1;
+    SDL_CondSignal(store->wake);
+    SDL_UnlockMutex(store->mutex);
+
+    SDL_WaitThread(store->writer, NULL);
+    freeStore(store);
+}
+
+int statsRecord(StatsStore* store, GameRecord* record) {
+    /* bbbv is the whole board's, so it only measures efficiency on a win */
+    Uint32 efficiency = record->won && record->clicks ? record->bbbv * 100 / record->clicks : 0;
+    record->efficiency = efficiency > 0xFFFF ? 0xFFFF : efficiency;
+    memset(record->reserved, 0, sizeof(record->reserved));
+    record->checksum = recordChecksum(record);
+
+    SDL_LockMutex(store->mutex);
+    if (store->queueLength == STATS_QUEUE_SIZE) {
+        SDL_UnlockMutex(store->mutex);
+        fprintf(stderr, "Stats: queue full, game not recorded\n");
+        return 1;
+    }
+    store->queue[(store->queueHead + store->queueLength) % STATS_QUEUE_SIZE] = *record;
+    store->queueLength++;
+    SDL_CondSignal(store->wake);
+    SDL_UnlockMutex(store->mutex);
+    return 0;
+}
+
+int statsTop(StatsStore* store, int width, int height, int mines, GameRecord* out, int n) {
+    int copied = 0;
+
+    if (n <= 0) {
+        return 0;
+    }
+
+    SDL_LockMutex(store->mutex);
+    StatsGroup* group = findGroup(store, width, height, mines);
+    if (group) {
+        copied = group->count < n ? group->count : n;
+        memcpy(out, group->top, sizeof(GameRecord) * copied);
+    }
+    SDL_UnlockMutex(store->mutex);
+
+    return copied;
+}
+
+void statsTotals(StatsStore* store, int width, int height, int mines, Uint32* played, Uint32* won) {
+    SDL_LockMutex(store->mutex);
+    StatsGroup* group = findGroup(store, width, height, mines);
+    *played = group ? group->played : 0;
+    *won = group ? group->won : 0;
+    SDL_UnlockMutex(store->mutex);
+}
@@ -0,0 +1,81 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <SDL2/SDL.h>
+
+/* Persistent game statistics.
+
+   Every finished game is appended to a log of fixed-size, checksummed
+   records; the log is never rewritten. Leaderboards are served from an index
+   holding the fastest wins per board setup, kept in memory and checkpointed
+   to its own file. On open only the log written after the last checkpoint is
+   replayed, and a record torn by a crash is cut off. Appends and checkpoints
+   hold an flock on the log, so several instances can share the same files.
+
+   statsRecord() only queues the record: a writer thread does the disk work,
+   so the game loop never waits on I/O. */
+
+#define STATS_TOP_SIZE 100
+#define STATS_QUEUE_SIZE 64
+#define STATS_CHECKPOINT_INTERVAL 64
+
+typedef struct {
+    Sint64 timestamp;
+    Uint32 seed;
+    Uint32 durationMs;
+    Uint32 bbbv;
+    Uint32 clicks;
+    Uint16 width;
+    Uint16 height;
+    Uint16 mines;
+    Uint16 efficiency; /* 3BV / clicks, in percent; 0 for losses */
+    Uint8 won;
+    Uint8 reserved[3];
+    Uint32 checksum;
+} GameRecord;
+
+typedef struct {
+    Uint16 width;
+    Uint16 height;
+    Uint16 mines;
+    Uint16 count;
+    Uint32 played;
+    Uint32 won;
+    GameRecord top[STATS_TOP_SIZE]; /* fastest wins, ascending */
+} StatsGroup;
+
+typedef struct {
+    FILE* log;
+    char* indexPath;
+
+    StatsGroup* groups;
+    int groupCount;
+    Uint64 logOffset;
+    int sinceCheckpoint;
+
+    GameRecord queue[STATS_QUEUE_SIZE];
+    int queueHead;
+    int queueLength;
+    int stopping;
+
+    SDL_mutex* mutex;
+    SDL_cond* wake;
+    SDL_Thread* writer;
+} StatsStore;
+
+int statsOpen(StatsStore* store, const char* logPath, const char* indexPath);
+void statsClose(StatsStore* store);
+
+/* Fills in the checksum and efficiency and queues the record. Never blocks on
+   disk; returns 1 if the queue is full and the record was dropped. */
+int statsRecord(StatsStore* store, GameRecord* record);
+
+/* Copies up to `n` fastest wins for the board setup into `out` and returns
+   how many were copied. */
+int statsTop(StatsStore* store, int width, int height, int mines, GameRecord* out, int n);
+
+/* Games played and won for the board setup */
+void statsTotals(StatsStore* store, int width, int height, int mines, Uint32* played, Uint32* won);
+
+#endif